@@ -4,6 +4,8 @@
 #include <string>
 #include <cstddef>
 #include "prefetch.hpp"
+#include "trace.hpp"
+#include "util.hpp"
 
 enum class WritePolicy { WriteBack, WriteThrough };
 enum class AllocatePolicy { WriteAllocate, NoWriteAllocate };
@@ -43,7 +45,7 @@ public:
 
     // Access in terms of byte address + op.
     // Returns hit/miss and eviction info.
-    AccessResult access(char op, uint64_t byte_addr);
+    AccessResult access(Op op, uint64_t byte_addr);
 
     // Insert a block (used when lower level returns data)
     // make_dirty indicates write allocate on store for WB
@@ -53,6 +55,23 @@ public:
     // (treat as a write to that block, but without counting as a demand access)
     void writeback_block(uint64_t block_addr);
 
+    // Same as above with the write policy fixed at compile time.
+    // WB must match cfg().wp; the hierarchy selects it once per run.
+    template <bool WB> AccessResult access(Op op, uint64_t byte_addr);
+    template <bool WB> AccessResult fill(uint64_t byte_addr, bool make_dirty);
+    template <bool WB> void writeback_block(uint64_t block_addr);
+
+    // Set index for a byte address, and a host prefetch of that set's lines.
+    // Lets batched callers pull tag metadata in ahead of the access.
+    std::size_t set_index(uint64_t byte_addr) const {
+        return static_cast<std::size_t>(block_addr(byte_addr) & (static_cast<uint64_t>(num_sets_ - 1)));
+    }
+    void prefetch_set(std::size_t set_idx) const {
+        const char* p = reinterpret_cast<const char*>(&lines_[set_idx * cfg_.assoc]);
+        const std::size_t bytes = cfg_.assoc * sizeof(Line);
+        for (std::size_t off = 0; off < bytes; off += 64) host_prefetch(p + off);
+    }
+
     // Prefetch buffer helper: check if demand access hits buffer
     bool prefetch_hit_consume(uint64_t block_addr) { return pfb_.consume_if_present(block_addr); }
     void prefetch_push(uint64_t block_addr) { pfb_.push(block_addr); }
@@ -82,13 +101,17 @@ private:
     std::size_t index_bits_ = 0;
     uint64_t use_counter_ = 0;
 
-    std::vector<std::vector<Line>> sets_;
+    // All sets in one contiguous array: set s occupies [s*assoc, (s+1)*assoc)
+    std::vector<Line> lines_;
 
 private:
     void validate_cfg();
+    Line* set_lines(std::size_t set_idx) { return &lines_[set_idx * cfg_.assoc]; }
+    const Line* set_lines(std::size_t set_idx) const { return &lines_[set_idx * cfg_.assoc]; }
     void decode(uint64_t byte_addr, uint64_t& tag, std::size_t& set_idx) const;
     int find_way(std::size_t set_idx, uint64_t tag) const;
     std::size_t choose_victim(std::size_t set_idx) const;
 
+    template <bool WB>
     AccessResult install(std::size_t set_idx, std::size_t way, uint64_t tag, bool dirty);
 };
@@ -1,5 +1,7 @@
 #pragma once
 #include "cache.hpp"
+#include "trace.hpp"
+#include <cstddef>
 
 struct HierarchyStats {
     uint64_t l1_prefetch_dem_hits = 0;
@@ -13,17 +15,34 @@ public:
     void reset();
 
     // Demand access from CPU: returns final hit status (L1/L2/mem)
-    void access(char op, uint64_t addr);
+    void access(Op op, uint64_t addr);
+
+    // Run n demand accesses in order; same results as calling access() on each.
+    // Set indices are decoded a few ops ahead and the matching L1/L2 tag sets
+    // are prefetched on the host, hiding misses on large tag arrays.
+    void access_batch(const TraceOp* ops, std::size_t n);
 
     const Cache& L1() const { return l1_; }
     const Cache& L2() const { return l2_; }
     const HierarchyStats& hstats() const { return hstats_; }
 
 private:
+    // How many ops ahead access_batch prefetches set metadata
+    static constexpr std::size_t kPrefetchDistance = 8;
+
     Cache l1_;
     Cache l2_;
     HierarchyStats hstats_;
 
+    // Loops specialized for the configured features, picked at construction
+    void (CacheHierarchy::*access_fn_)(Op, uint64_t) = nullptr;
+    void (CacheHierarchy::*batch_fn_)(const TraceOp*, std::size_t) = nullptr;
+
 private:
+    // P1/P2: next-line prefetch buffer active at L1/L2; W1/W2: write-back at L1/L2
+    template <bool P1, bool P2, bool W1, bool W2> void access_impl(Op op, uint64_t addr);
+    template <bool P1, bool P2, bool W1, bool W2> void batch_impl(const TraceOp* ops, std::size_t n);
+    template <bool... Fs> void select_kernels(const bool (&flags)[4]);
+
     void maybe_prefetch(Cache& c, uint64_t addr);
 };
@@ -3,8 +3,10 @@
 #include <string>
 #include <vector>
 
+enum class Op : uint8_t { Read, Write };
+
 struct TraceOp {
-    char op;        // 'r' or 'w'
+    Op op;          // validated by TraceReader
     uint64_t addr;  // byte address
 };
 
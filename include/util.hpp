@@ -11,3 +11,13 @@ inline std::size_t ilog2_pow2(std::size_t x) {
     while (x > 1) { x >>= 1; ++r; }
     return r;
 }
+
+// Host-side software prefetch hint (for the simulator's own data structures).
+// Prefetched with write intent: tag metadata is updated on every access.
+inline void host_prefetch(const void* p) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(p, 1, 3);
+#else
+    (void)p;
+#endif
+}
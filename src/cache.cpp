@@ -17,7 +17,7 @@ void Cache::reset() {
     offset_bits_ = ilog2_pow2(cfg_.block_bytes);
     index_bits_  = ilog2_pow2(num_sets_);
 
-    sets_.assign(num_sets_, std::vector<Line>(cfg_.assoc));
+    lines_.assign(num_sets_ * cfg_.assoc, Line{});
 }
 
 void Cache::validate_cfg() {
@@ -52,35 +52,35 @@ uint64_t Cache::next_block_addr(uint64_t byte_addr) const {
 }
 
 void Cache::decode(uint64_t byte_addr, uint64_t& tag, std::size_t& set_idx) const {
-    uint64_t b = block_addr(byte_addr);
-    set_idx = static_cast<std::size_t>(b & (static_cast<uint64_t>(num_sets_ - 1)));
-    tag = b >> index_bits_;
+    set_idx = set_index(byte_addr);
+    tag = block_addr(byte_addr) >> index_bits_;
 }
 
 int Cache::find_way(std::size_t set_idx, uint64_t tag) const {
-    const auto& set = sets_[set_idx];
-    for (std::size_t w = 0; w < set.size(); ++w) {
+    const Line* set = set_lines(set_idx);
+    for (std::size_t w = 0; w < cfg_.assoc; ++w) {
         if (set[w].valid && set[w].tag == tag) return static_cast<int>(w);
     }
     return -1;
 }
 
 std::size_t Cache::choose_victim(std::size_t set_idx) const {
-    const auto& set = sets_[set_idx];
-    for (std::size_t w = 0; w < set.size(); ++w)
+    const Line* set = set_lines(set_idx);
+    for (std::size_t w = 0; w < cfg_.assoc; ++w)
         if (!set[w].valid) return w;
 
     std::size_t victim = 0;
     uint64_t best = set[0].last_use;
-    for (std::size_t w = 1; w < set.size(); ++w) {
+    for (std::size_t w = 1; w < cfg_.assoc; ++w) {
         if (set[w].last_use < best) { best = set[w].last_use; victim = w; }
     }
     return victim;
 }
 
+template <bool WB>
 AccessResult Cache::install(std::size_t set_idx, std::size_t way, uint64_t tag, bool dirty) {
     AccessResult res;
-    auto& line = sets_[set_idx][way];
+    auto& line = set_lines(set_idx)[way];
 
     if (line.valid) {
         res.eviction = true;
@@ -89,7 +89,7 @@ AccessResult Cache::install(std::size_t set_idx, std::size_t way, uint64_t tag,
         // reconstruct evicted block addr = (tag << index_bits) | set_idx
         res.evicted_block_addr = (line.tag << index_bits_) | static_cast<uint64_t>(set_idx);
 
-        if (cfg_.wp == WritePolicy::WriteBack && line.dirty) {
+        if (WB && line.dirty) {
             res.eviction_dirty = true;
             stats_.writebacks++;
         }
@@ -102,12 +102,26 @@ AccessResult Cache::install(std::size_t set_idx, std::size_t way, uint64_t tag,
     return res;
 }
 
-AccessResult Cache::access(char op, uint64_t byte_addr) {
-    if (op != 'r' && op != 'w') return {};
+AccessResult Cache::access(Op op, uint64_t byte_addr) {
+    return cfg_.wp == WritePolicy::WriteBack ? access<true>(op, byte_addr)
+                                             : access<false>(op, byte_addr);
+}
+
+AccessResult Cache::fill(uint64_t byte_addr, bool make_dirty) {
+    return cfg_.wp == WritePolicy::WriteBack ? fill<true>(byte_addr, make_dirty)
+                                             : fill<false>(byte_addr, make_dirty);
+}
 
+void Cache::writeback_block(uint64_t block_addr_in) {
+    if (cfg_.wp == WritePolicy::WriteBack) writeback_block<true>(block_addr_in);
+    else writeback_block<false>(block_addr_in);
+}
+
+template <bool WB>
+AccessResult Cache::access(Op op, uint64_t byte_addr) {
     use_counter_++;
 
-    if (op == 'r') stats_.reads++;
+    if (op == Op::Read) stats_.reads++;
     else stats_.writes++;
 
     uint64_t tag; std::size_t set_idx;
@@ -115,13 +129,13 @@ AccessResult Cache::access(char op, uint64_t byte_addr) {
 
     int way = find_way(set_idx, tag);
     if (way >= 0) {
-        auto& line = sets_[set_idx][static_cast<std::size_t>(way)];
+        auto& line = set_lines(set_idx)[static_cast<std::size_t>(way)];
         line.last_use = use_counter_;
 
-        if (op == 'r') stats_.read_hits++;
+        if (op == Op::Read) stats_.read_hits++;
         else {
             stats_.write_hits++;
-            if (cfg_.wp == WritePolicy::WriteBack) line.dirty = true;
+            if (WB) line.dirty = true;
             // WT would "write to memory" at this level; hierarchy models that.
         }
 
@@ -129,12 +143,13 @@ AccessResult Cache::access(char op, uint64_t byte_addr) {
     }
 
     // miss
-    if (op == 'r') stats_.read_misses++;
+    if (op == Op::Read) stats_.read_misses++;
     else stats_.write_misses++;
 
     return {.hit=false};
 }
 
+template <bool WB>
 AccessResult Cache::fill(uint64_t byte_addr, bool make_dirty) {
     use_counter_++;
 
@@ -144,16 +159,17 @@ AccessResult Cache::fill(uint64_t byte_addr, bool make_dirty) {
     // If already present, just update dirty/use
     int way = find_way(set_idx, tag);
     if (way >= 0) {
-        auto& line = sets_[set_idx][static_cast<std::size_t>(way)];
+        auto& line = set_lines(set_idx)[static_cast<std::size_t>(way)];
         line.last_use = use_counter_;
-        if (make_dirty && cfg_.wp == WritePolicy::WriteBack) line.dirty = true;
+        if (make_dirty && WB) line.dirty = true;
         return {.hit=true};
     }
 
     std::size_t victim = choose_victim(set_idx);
-    return install(set_idx, victim, tag, (make_dirty && cfg_.wp == WritePolicy::WriteBack));
+    return install<WB>(set_idx, victim, tag, (make_dirty && WB));
 }
 
+template <bool WB>
 void Cache::writeback_block(uint64_t block_addr_in) {
     // treat as a write to that block (no demand stats)
     use_counter_++;
@@ -166,13 +182,21 @@ void Cache::writeback_block(uint64_t block_addr_in) {
 
     int way = find_way(set_idx, tag);
     if (way >= 0) {
-        auto& line = sets_[set_idx][static_cast<std::size_t>(way)];
+        auto& line = set_lines(set_idx)[static_cast<std::size_t>(way)];
         line.last_use = use_counter_;
-        if (cfg_.wp == WritePolicy::WriteBack) line.dirty = true;
+        if (WB) line.dirty = true;
         return;
     }
 
     std::size_t victim = choose_victim(set_idx);
-    auto res = install(set_idx, victim, tag, (cfg_.wp == WritePolicy::WriteBack));
+    auto res = install<WB>(set_idx, victim, tag, WB);
     (void)res;
 }
+
+// Both write-policy variants are used by CacheHierarchy's specialized loops.
+template AccessResult Cache::access<true>(Op, uint64_t);
+template AccessResult Cache::access<false>(Op, uint64_t);
+template AccessResult Cache::fill<true>(uint64_t, bool);
+template AccessResult Cache::fill<false>(uint64_t, bool);
+template void Cache::writeback_block<true>(uint64_t);
+template void Cache::writeback_block<false>(uint64_t);
@@ -1,7 +1,30 @@
 #include "hierarchy.hpp"
 
+// Prefetch buffers only ever fill via next-line prefetch, so both must be on.
+static bool prefetch_active(const CacheConfig& c) {
+    return c.next_line_prefetch && c.prefetch_buf_entries != 0;
+}
+
 CacheHierarchy::CacheHierarchy(const CacheConfig& l1, const CacheConfig& l2)
-    : l1_(l1), l2_(l2) {}
+    : l1_(l1), l2_(l2) {
+    const bool flags[4] = {
+        prefetch_active(l1_.cfg()), prefetch_active(l2_.cfg()),
+        l1_.cfg().wp == WritePolicy::WriteBack, l2_.cfg().wp == WritePolicy::WriteBack,
+    };
+    select_kernels<>(flags);
+}
+
+template <bool... Fs>
+void CacheHierarchy::select_kernels(const bool (&flags)[4]) {
+    if constexpr (sizeof...(Fs) == 4) {
+        (void)flags;
+        access_fn_ = &CacheHierarchy::access_impl<Fs...>;
+        batch_fn_ = &CacheHierarchy::batch_impl<Fs...>;
+    } else {
+        if (flags[sizeof...(Fs)]) select_kernels<Fs..., true>(flags);
+        else select_kernels<Fs..., false>(flags);
+    }
+}
 
 void CacheHierarchy::reset() {
     l1_.reset();
@@ -10,34 +33,55 @@ void CacheHierarchy::reset() {
 }
 
 void CacheHierarchy::maybe_prefetch(Cache& c, uint64_t addr) {
-    if (!c.cfg().next_line_prefetch) return;
-    if (c.cfg().prefetch_buf_entries == 0) return;
-
     uint64_t next_blk = c.next_block_addr(addr);
     c.prefetch_push(next_blk);
 }
 
-void CacheHierarchy::access(char op, uint64_t addr) {
-    if (op != 'r' && op != 'w') return;
+void CacheHierarchy::access(Op op, uint64_t addr) {
+    (this->*access_fn_)(op, addr);
+}
+
+void CacheHierarchy::access_batch(const TraceOp* ops, std::size_t n) {
+    (this->*batch_fn_)(ops, n);
+}
 
+template <bool P1, bool P2, bool W1, bool W2>
+void CacheHierarchy::batch_impl(const TraceOp* ops, std::size_t n) {
+    const std::size_t warm = n < kPrefetchDistance ? n : kPrefetchDistance;
+    for (std::size_t i = 0; i < warm; ++i) {
+        l1_.prefetch_set(l1_.set_index(ops[i].addr));
+        l2_.prefetch_set(l2_.set_index(ops[i].addr));
+    }
+
+    for (std::size_t i = 0; i < n; ++i) {
+        if (i + kPrefetchDistance < n) {
+            uint64_t ahead = ops[i + kPrefetchDistance].addr;
+            l1_.prefetch_set(l1_.set_index(ahead));
+            l2_.prefetch_set(l2_.set_index(ahead));
+        }
+        access_impl<P1, P2, W1, W2>(ops[i].op, ops[i].addr);
+    }
+}
+
+template <bool P1, bool P2, bool W1, bool W2>
+void CacheHierarchy::access_impl(Op op, uint64_t addr) {
     // -----------------------------
     // 0) Prefetch buffer checks
     // -----------------------------
 
     // L1 prefetch buffer demand hit check
-    uint64_t l1_blk = l1_.block_addr(addr);
-    if (l1_.cfg().prefetch_buf_entries && l1_.prefetch_hit_consume(l1_blk)) {
+    if (P1 && l1_.prefetch_hit_consume(l1_.block_addr(addr))) {
         hstats_.l1_prefetch_dem_hits++;
 
         // Fill L1 with the prefetched line (clean)
-        auto ev = l1_.fill(addr, /*make_dirty=*/false);
+        auto ev = l1_.fill<W1>(addr, /*make_dirty=*/false);
         if (ev.eviction && ev.eviction_dirty) {
             // writeback evicted dirty line from L1 into L2
-            l2_.writeback_block(ev.evicted_block_addr);
+            l2_.writeback_block<W2>(ev.evicted_block_addr);
         }
 
         // Now do the real access (will be a hit in L1)
-        (void)l1_.access(op, addr);
+        (void)l1_.access<W1>(op, addr);
 
         // Issue next-line prefetches
         maybe_prefetch(l1_, addr);
@@ -47,38 +91,36 @@ void CacheHierarchy::access(char op, uint64_t addr) {
     // -----------------------------
     // 1) L1 access
     // -----------------------------
-    auto r1 = l1_.access(op, addr);
+    auto r1 = l1_.access<W1>(op, addr);
     if (r1.hit) {
-        maybe_prefetch(l1_, addr);
+        if (P1) maybe_prefetch(l1_, addr);
         return;
     }
 
     // Decide whether L1 will allocate on this op
-    bool l1_will_allocate = !(op == 'w' && l1_.cfg().ap == AllocatePolicy::NoWriteAllocate);
+    bool l1_will_allocate = !(op == Op::Write && l1_.cfg().ap == AllocatePolicy::NoWriteAllocate);
 
     // -----------------------------
     // 2) L2 prefetch buffer demand hit check
     // -----------------------------
-    uint64_t l2_blk = l2_.block_addr(addr);
-    bool l2_pfb_hit = (l2_.cfg().prefetch_buf_entries && l2_.prefetch_hit_consume(l2_blk));
-    if (l2_pfb_hit) {
+    if (P2 && l2_.prefetch_hit_consume(l2_.block_addr(addr))) {
         hstats_.l2_prefetch_dem_hits++;
 
         // Fill L2 with prefetched line (clean)
-        (void)l2_.fill(addr, /*make_dirty=*/false);
+        (void)l2_.fill<W2>(addr, /*make_dirty=*/false);
         // Continue to L2 access below (should now be a hit)
     }
 
     // -----------------------------
     // 3) L2 access
     // -----------------------------
-    auto r2 = l2_.access(op, addr);
+    auto r2 = l2_.access<W2>(op, addr);
 
     if (!r2.hit) {
         // L2 miss -> memory (modeled as always returns the block)
         // Fill L2: if store + write-allocate => may become dirty in WB
-        bool l2_make_dirty = (op == 'w') && (l2_.cfg().ap == AllocatePolicy::WriteAllocate);
-        auto ev2 = l2_.fill(addr, l2_make_dirty);
+        bool l2_make_dirty = (op == Op::Write) && (l2_.cfg().ap == AllocatePolicy::WriteAllocate);
+        auto ev2 = l2_.fill<W2>(addr, l2_make_dirty);
         (void)ev2;
     } else {
         // L2 hit: if WT and op is write, it would write to memory;
@@ -86,22 +128,22 @@ void CacheHierarchy::access(char op, uint64_t addr) {
     }
 
     // Issue L2 next-line prefetch
-    maybe_prefetch(l2_, addr);
+    if (P2) maybe_prefetch(l2_, addr);
 
     // -----------------------------
     // 4) **CRITICAL FIX**: Fill L1 on demand miss
     // -----------------------------
     if (l1_will_allocate) {
-        bool l1_make_dirty = (op == 'w') && (l1_.cfg().ap == AllocatePolicy::WriteAllocate);
+        bool l1_make_dirty = (op == Op::Write) && (l1_.cfg().ap == AllocatePolicy::WriteAllocate);
 
-        auto ev1 = l1_.fill(addr, l1_make_dirty);
+        auto ev1 = l1_.fill<W1>(addr, l1_make_dirty);
 
         // If L1 evicted a dirty line, write it back to L2
         if (ev1.eviction && ev1.eviction_dirty) {
-            l2_.writeback_block(ev1.evicted_block_addr);
+            l2_.writeback_block<W2>(ev1.evicted_block_addr);
         }
     }
 
     // Issue L1 next-line prefetch after demand install
-    maybe_prefetch(l1_, addr);
+    if (P1) maybe_prefetch(l1_, addr);
 }
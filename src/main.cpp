@@ -74,7 +74,7 @@ int main(int argc, char** argv) {
         auto ops = TraceReader::read_file(trace_path);
 
         CacheHierarchy h(l1, l2);
-        for (const auto& t : ops) h.access(t.op, t.addr);
+        h.access_batch(ops.data(), ops.size());
 
         const auto& s1 = h.L1().stats();
         const auto& s2 = h.L2().stats();
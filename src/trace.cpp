@@ -23,7 +23,7 @@ std::vector<TraceOp> TraceReader::read_file(const std::string& path) {
         if (op != 'r' && op != 'w') continue;
 
         uint64_t addr = std::stoull(addr_s, nullptr, 0);
-        ops.push_back({op, addr});
+        ops.push_back({op == 'w' ? Op::Write : Op::Read, addr});
     }
     return ops;
 }